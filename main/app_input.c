@@ -0,0 +1,144 @@
+#include "app_input.h"
+#include "app_state.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BTN";
+
+#define BTN_LEFT_GPIO       GPIO_NUM_41
+#define BTN_MIDDLE_GPIO     GPIO_NUM_38
+#define BTN_RIGHT_GPIO      GPIO_NUM_17
+#define BTN_DEBOUNCE_MS     80      // Level sampled this long after the first edge
+#define BTN_LONG_PRESS_MS   700
+#define INPUT_TASK_STACK    3072
+#define INPUT_TASK_PRIO     5
+
+static const struct {
+    gpio_num_t gpio;
+    const char *name;
+} buttons[APP_BUTTON_COUNT] = {
+    [APP_BUTTON_LEFT] = { BTN_LEFT_GPIO, "LEFT" },
+    [APP_BUTTON_MIDDLE] = { BTN_MIDDLE_GPIO, "MIDDLE" },
+    [APP_BUTTON_RIGHT] = { BTN_RIGHT_GPIO, "RIGHT" },
+};
+
+typedef struct {
+    esp_timer_handle_t debounce;
+    esp_timer_handle_t long_press;
+    volatile int64_t edge_us;   // First edge of the current transition
+    int level;                  // Debounced level; pull-up, so 0 = pressed
+} button_t;
+
+static button_t state[APP_BUTTON_COUNT];
+static TaskHandle_t input_task_handle;
+static uint32_t latency_max_us;
+
+// Interrupt on the level the button is not at. Level rather than edge
+// triggered so the same setting wakes the chip from light sleep, and a
+// transition that happened while the interrupt was off still fires.
+static void arm(int i) {
+    gpio_wakeup_enable(buttons[i].gpio, state[i].level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    gpio_intr_enable(buttons[i].gpio);
+}
+
+// One interrupt per transition: the handler disarms the pin, so contact
+// bounce costs nothing until the debounce timer samples the settled level.
+static void IRAM_ATTR button_isr(void *arg) {
+    int i = (int)(intptr_t)arg;
+    gpio_intr_disable(buttons[i].gpio);
+    state[i].edge_us = esp_timer_get_time();
+
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(input_task_handle, 1u << i, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// esp_timer callbacks all run in the esp_timer task, one at a time, so
+// they share button_t without locking
+static void debounce_cb(void *arg) {
+    int i = (int)(intptr_t)arg;
+    button_t *b = &state[i];
+    int level = gpio_get_level(buttons[i].gpio);
+
+    if (level != b->level) {
+        b->level = level;
+        if (level == 0) {
+            uint32_t latency_us = (uint32_t)(esp_timer_get_time() - b->edge_us);
+            if (latency_us > latency_max_us) latency_max_us = latency_us;
+            ESP_LOGI(TAG, "%s press detected (GPIO%d), %lu us after the edge, worst %lu us", buttons[i].name,
+                     buttons[i].gpio, (unsigned long)latency_us, (unsigned long)latency_max_us);
+            esp_timer_start_once(b->long_press, BTN_LONG_PRESS_MS * 1000);
+            app_state_post(APP_SOURCE_INPUT, APP_EVENT_PRESS, i);
+        } else {
+            esp_timer_stop(b->long_press);
+            app_state_post(APP_SOURCE_INPUT, APP_EVENT_RELEASE, i);
+        }
+    }
+    // A glitch that settled back to the old level produces no event
+    arm(i);
+}
+
+static void long_press_cb(void *arg) {
+    int i = (int)(intptr_t)arg;
+    if (state[i].level == 0) {
+        ESP_LOGI(TAG, "%s long press", buttons[i].name);
+        app_state_post(APP_SOURCE_INPUT, APP_EVENT_LONG_PRESS, i);
+    }
+}
+
+// Starts the debounce timers; esp_timer_start_once() is not callable from
+// the GPIO interrupt
+static void input_task(void *arg) {
+    for (;;) {
+        uint32_t pending = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &pending, portMAX_DELAY);
+        for (int i = 0; i < APP_BUTTON_COUNT; i++) {
+            if (pending & (1u << i)) {
+                esp_timer_start_once(state[i].debounce, BTN_DEBOUNCE_MS * 1000);
+            }
+        }
+    }
+}
+
+void app_input_start(void) {
+    xTaskCreate(input_task, "input", INPUT_TASK_STACK, NULL, INPUT_TASK_PRIO, &input_task_handle);
+
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {  // Already installed by a driver
+        ESP_LOGE(TAG, "GPIO ISR service: %s", esp_err_to_name(err));
+        return;
+    }
+    for (int i = 0; i < APP_BUTTON_COUNT; i++) {
+        gpio_config_t cfg = {
+            .pin_bit_mask = 1ULL << buttons[i].gpio,
+            .mode         = GPIO_MODE_INPUT,
+            .pull_up_en   = GPIO_PULLUP_ENABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type    = GPIO_INTR_DISABLE,
+        };
+        gpio_config(&cfg);
+
+        esp_timer_create_args_t debounce_args = {
+            .callback = debounce_cb,
+            .arg = (void *)(intptr_t)i,
+            .name = "btn_debounce",
+        };
+        esp_timer_create(&debounce_args, &state[i].debounce);
+        esp_timer_create_args_t long_press_args = {
+            .callback = long_press_cb,
+            .arg = (void *)(intptr_t)i,
+            .name = "btn_long",
+        };
+        esp_timer_create(&long_press_args, &state[i].long_press);
+
+        state[i].level = gpio_get_level(buttons[i].gpio);
+        gpio_isr_handler_add(buttons[i].gpio, button_isr, (void *)(intptr_t)i);
+        arm(i);
+    }
+    // Lets a button press end automatic light sleep
+    esp_sleep_enable_gpio_wakeup();
+}
@@ -0,0 +1,15 @@
+#ifndef APP_INPUT_H
+#define APP_INPUT_H
+
+// The three buttons (pull-ups, pressed = low). Each pin interrupts on the
+// level it is not at and is disarmed on the first edge; an esp_timer
+// samples it BTN_DEBOUNCE_MS later and, if the level changed, posts
+// APP_EVENT_PRESS or APP_EVENT_RELEASE to the state task, plus
+// APP_EVENT_LONG_PRESS if the button is still held BTN_LONG_PRESS_MS after
+// the press. A press therefore reaches the state task BTN_DEBOUNCE_MS plus
+// one task switch after the first edge; the log keeps the worst case seen.
+// The same level triggers are GPIO wake-up sources, so presses also end
+// automatic light sleep.
+void app_input_start(void);
+
+#endif // APP_INPUT_H
@@ -0,0 +1,438 @@
+#include "app_state.h"
+#include "event_ring.h"
+#include "assets/animations/animations.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+static const char *TAG = "STATE";
+
+#define STATE_TASK_STACK    4096
+#define STATE_TASK_PRIO     4
+#define PERSIST_TASK_STACK  3072
+#define PERSIST_TASK_PRIO   1       // Below everything that draws
+#define WRITE_WORDS         250
+#define DAY_TICKS           ((TickType_t)configTICK_RATE_HZ * 60 * 60 * 24)
+
+// What gets written to NVS
+typedef struct {
+    int32_t words;
+    int32_t health;
+    tamagotchi_state_t tama;
+} app_snapshot_t;
+
+static event_ring_t rings[APP_SOURCE_COUNT];
+static TaskHandle_t state_task_handle;
+static QueueHandle_t persist_mailbox;
+static app_view_cb_t view_cb;
+
+// The model. Only the state task touches it once app_state_start() ran.
+static int32_t words_count;
+static int32_t health_count = HEALTH_FULL;
+static tamagotchi_state_t tama;
+static int32_t selected_icon;
+static bool writing_anim_active;
+static tamagotchi_anim_t anim_type;
+static bool anim_loop = true;
+static uint32_t anim_seq;
+
+// One-shot deadlines. Each is an esp_timer whose callback posts
+// APP_EVENT_DEADLINE to the state task, so between events and deadlines
+// the state task, and with light sleep the chip, sleeps.
+typedef enum {
+    DEADLINE_WRITING_END,       // The writing animation has run its time
+    DEADLINE_DAY,               // Next get_current_date_key() rollover
+    DEADLINE_CELEBRATION_END,   // The celebrate animation played once
+    DEADLINE_COUNT
+} deadline_t;
+
+static esp_timer_handle_t deadlines[DEADLINE_COUNT];
+
+// Inputs of the derived values. Every change to one is flagged in
+// `changed`; refresh() recomputes only the values that depend on a flagged
+// input and clears the flags.
+enum {
+    IN_WORDS        = 1 << 0,
+    IN_MISSED_DAYS  = 1 << 1,   // tama.consecutive_missed_days
+    IN_HEALTH_COUNT = 1 << 2,
+    IN_WRITING_ANIM = 1 << 3,   // writing_anim_active
+    IN_SELECTED     = 1 << 4,
+    IN_CELEBRATION  = 1 << 5,   // tama.celebration_played
+    IN_LIFECYCLE    = 1 << 6,   // Derived, but inputs of the animation
+    IN_HEALTH       = 1 << 7,
+    IN_ANIM         = 1 << 8,   // anim_type/loop/seq
+    IN_ALL          = (1 << 9) - 1,
+};
+
+static uint32_t changed = IN_ALL;
+static uint32_t recomputed;
+static uint32_t avoided;
+
+static void deadline_cb(void *arg) {
+    app_state_post(APP_SOURCE_TIMER, APP_EVENT_DEADLINE, (int32_t)(intptr_t)arg);
+}
+
+// (Re)arm a deadline `ms` from now
+static void schedule(deadline_t deadline, uint64_t ms) {
+    esp_timer_stop(deadlines[deadline]);  // Fails harmlessly if it is not running
+    esp_timer_start_once(deadlines[deadline], ms * 1000);
+}
+
+static void create_deadlines(void) {
+    static const char *names[DEADLINE_COUNT] = {"writing_end", "day", "celebration_end"};
+    for (int i = 0; i < DEADLINE_COUNT; i++) {
+        esp_timer_create_args_t args = {
+            .callback = deadline_cb,
+            .arg = (void *)(intptr_t)i,
+            .name = names[i],
+        };
+        esp_timer_create(&args, &deadlines[i]);
+    }
+}
+
+static void load(void) {
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+
+    nvs_handle_t handle;
+    if (nvs_open("tama", NVS_READWRITE, &handle) == ESP_OK) {
+        int32_t value = 0;
+        if (nvs_get_i32(handle, "words", &value) == ESP_OK) {
+            words_count = value;
+        }
+        value = 0;
+        if (nvs_get_i32(handle, "health", &value) == ESP_OK) {
+            health_count = value;
+        }
+        nvs_close(handle);
+    }
+
+    tamagotchi_state_init(&tama);
+    tamagotchi_state_load(&tama);
+}
+
+static void persist_task(void *arg) {
+    app_snapshot_t snapshot;
+    for (;;) {
+        xQueueReceive(persist_mailbox, &snapshot, portMAX_DELAY);
+        uint32_t start = esp_log_timestamp();
+        nvs_handle_t handle;
+        if (nvs_open("tama", NVS_READWRITE, &handle) == ESP_OK) {
+            nvs_set_i32(handle, "words", snapshot.words);
+            nvs_set_i32(handle, "health", snapshot.health);
+            nvs_commit(handle);
+            nvs_close(handle);
+        }
+        tamagotchi_state_save(&snapshot.tama);
+        ESP_LOGD(TAG, "saved in %lu ms", (unsigned long)(esp_log_timestamp() - start));
+    }
+}
+
+// Hand the current model to the persistence task. A snapshot it has not
+// picked up yet is simply replaced.
+static void request_save(void) {
+    app_snapshot_t snapshot = {
+        .words = words_count,
+        .health = health_count,
+        .tama = tama,
+    };
+    xQueueOverwrite(persist_mailbox, &snapshot);
+}
+
+static void set_words(int32_t words) {
+    if (words != words_count) {
+        words_count = words;
+        changed |= IN_WORDS;
+    }
+}
+
+static void set_health_count(int32_t health) {
+    if (health != health_count) {
+        health_count = health;
+        changed |= IN_HEALTH_COUNT;
+    }
+}
+
+static void set_missed_days(int32_t days) {
+    if (days != tama.consecutive_missed_days) {
+        tama.consecutive_missed_days = days;
+        changed |= IN_MISSED_DAYS;
+    }
+}
+
+static void set_writing_anim(bool active) {
+    if (active != writing_anim_active) {
+        writing_anim_active = active;
+        changed |= IN_WRITING_ANIM;
+    }
+}
+
+static void set_selected_icon(int32_t icon) {
+    if (icon != selected_icon) {
+        selected_icon = icon;
+        changed |= IN_SELECTED;
+    }
+}
+
+static void start_anim(tamagotchi_anim_t type, bool loop) {
+    anim_type = type;
+    anim_loop = loop;
+    anim_seq++;
+    changed |= IN_ANIM;
+}
+
+// True if a value depending on `inputs` has to be recomputed
+static bool stale(uint32_t inputs) {
+    if (changed & inputs) {
+        recomputed++;
+        return true;
+    }
+    avoided++;
+    return false;
+}
+
+// Daily check, then arm the next one. The date key counts days since boot
+// (there is no RTC yet), so the check runs when it rolls over rather than
+// at a wall-clock midnight or 11:49 PM; a timer that fires a little early
+// finds the same key and simply re-arms.
+static void day_rollover(void) {
+    int32_t missed = tama.consecutive_missed_days;
+    check_daily_writing(&tama);
+    if (tama.consecutive_missed_days != missed) {
+        changed |= IN_MISSED_DAYS;
+    }
+    TickType_t left = DAY_TICKS - xTaskGetTickCount() % DAY_TICKS;
+    schedule(DEADLINE_DAY, (uint64_t)(left + 1) * portTICK_PERIOD_MS);
+}
+
+// Bring lifecycle, health and the animation up to date with their inputs.
+// Returns true if the view changed; the flags are cleared.
+static bool refresh(void) {
+    if (stale(IN_WORDS)) {
+        tamagotchi_lifecycle_t lifecycle = calculate_lifecycle(words_count);
+        if (lifecycle != tama.lifecycle) {
+            tama.lifecycle = lifecycle;
+            changed |= IN_LIFECYCLE;
+        }
+    }
+    if (stale(IN_MISSED_DAYS)) {
+        tamagotchi_health_t health = calculate_health_status(tama.consecutive_missed_days);
+        if (health != tama.health) {
+            tama.health = health;
+            changed |= IN_HEALTH;
+        }
+    }
+    // Also reapplied after the icons change the count
+    if (stale(IN_HEALTH | IN_HEALTH_COUNT)) {
+        if (tama.health == TAMA_HEALTH_DEAD) {
+            set_health_count(0);
+        } else if (tama.health == TAMA_HEALTH_HEALTHY) {
+            set_health_count(HEALTH_FULL);
+        }
+        // A sick tamagotchi earns its health back by writing
+    }
+    if (stale(IN_WORDS | IN_LIFECYCLE | IN_HEALTH | IN_WRITING_ANIM | IN_CELEBRATION)) {
+        tamagotchi_anim_t type = get_current_animation(&tama, words_count, writing_anim_active);
+        if (type != anim_type) {
+            start_anim(type, type != TAMA_ANIM_CELEBRATE);
+            // Played once, then marked as played and replaced
+            if (type == TAMA_ANIM_CELEBRATE) {
+                schedule(DEADLINE_CELEBRATION_END, animation_duration_ms(get_animation_for_type(type)));
+            }
+        }
+    }
+
+    bool view_changed = stale(IN_WORDS | IN_HEALTH_COUNT | IN_SELECTED | IN_ANIM);
+    changed = 0;
+    return view_changed;
+}
+
+static void write_action(void) {
+    set_words(words_count + WRITE_WORDS);
+
+    int32_t missed = tama.consecutive_missed_days;
+    mark_writing_activity(&tama);
+    if (tama.consecutive_missed_days != missed) {
+        changed |= IN_MISSED_DAYS;
+    }
+    if (tama.health == TAMA_HEALTH_SICK && tama.consecutive_writing_days > 0 && health_count < HEALTH_FULL) {
+        set_health_count(health_count + 1);
+        if (health_count >= HEALTH_FULL) {
+            set_missed_days(0);
+        }
+    }
+
+    // Restarts the writing animation even if it is already playing
+    if (tama.lifecycle == TAMA_LIFECYCLE_ADULT) {
+        set_writing_anim(true);
+        schedule(DEADLINE_WRITING_END, WRITING_ANIM_DURATION_MS);
+        start_anim(TAMA_ANIM_WRITING, true);
+    }
+
+    request_save();
+}
+
+static void icon_action(int32_t icon) {
+    switch (icon) {
+    case APP_ICON_WRITE:
+        write_action();
+        break;
+    case APP_ICON_LOG:
+        set_health_count(health_count + 1);
+        request_save();
+        break;
+    case APP_ICON_SETTINGS:
+        set_health_count(health_count - 1);
+        request_save();
+        break;
+    default:
+        break;
+    }
+}
+
+static void press_action(int32_t button) {
+    switch (button) {
+    case APP_BUTTON_LEFT:
+        if (selected_icon > 0) set_selected_icon(selected_icon - 1);
+        break;
+    case APP_BUTTON_RIGHT:
+        if (selected_icon < APP_ICON_COUNT - 1) set_selected_icon(selected_icon + 1);
+        break;
+    case APP_BUTTON_MIDDLE:
+        if (selected_icon == APP_ICON_WRITE) write_action();
+        break;
+    default:
+        break;
+    }
+}
+
+static void deadline_action(int32_t deadline) {
+    switch (deadline) {
+    case DEADLINE_WRITING_END:
+        set_writing_anim(false);
+        break;
+    case DEADLINE_DAY:
+        day_rollover();
+        break;
+    case DEADLINE_CELEBRATION_END:
+        tama.celebration_played = true;
+        changed |= IN_CELEBRATION;
+        request_save();
+        break;
+    default:
+        break;
+    }
+}
+
+static void handle_event(const event_ring_entry_t *event) {
+    switch ((app_event_type_t)event->type) {
+    case APP_EVENT_PRESS:
+        press_action(event->arg);
+        break;
+    case APP_EVENT_RELEASE:
+    case APP_EVENT_LONG_PRESS:
+        // Nothing acts on these yet
+        break;
+    case APP_EVENT_ICON_CLICKED:
+        icon_action(event->arg);
+        break;
+    case APP_EVENT_DEADLINE:
+        deadline_action(event->arg);
+        break;
+    }
+}
+
+static void make_view(app_view_t *view) {
+    view->words = words_count;
+    view->health = health_count;
+    view->selected_icon = selected_icon;
+    view->anim = anim_type;
+    view->anim_loop = anim_loop;
+    view->anim_seq = anim_seq;
+}
+
+// Apply everything posted since the last wake-up, one source after the
+// other; each ring keeps its own events in order. Returns the number of
+// events handled.
+// Derived values are refreshed after every event, so the next event in the
+// same pass sees the lifecycle and health the previous one produced.
+// Sets *view_changed if any of them changed something visible.
+static int drain(bool *view_changed) {
+    static uint32_t dropped_seen[APP_SOURCE_COUNT];
+    int handled = 0;
+    for (int source = 0; source < APP_SOURCE_COUNT; source++) {
+        event_ring_entry_t event;
+        while (event_ring_pop(&rings[source], &event)) {
+            ESP_LOGD(TAG, "event %lu from source %d, %lld us after posting", (unsigned long)event.type, source,
+                     (long long)(esp_timer_get_time() - event.time_us));
+            handle_event(&event);
+            *view_changed |= refresh();
+            handled++;
+        }
+        uint32_t dropped = event_ring_dropped(&rings[source]);
+        if (dropped != dropped_seen[source]) {
+            ESP_LOGW(TAG, "source %d: %lu event(s) dropped, %lu in total", source,
+                     (unsigned long)(dropped - dropped_seen[source]), (unsigned long)dropped);
+            dropped_seen[source] = dropped;
+        }
+    }
+    return handled;
+}
+
+// Events posted before the task started are handled on its first pass
+static void state_task(void *arg) {
+    for (;;) {
+        bool view_changed = false;
+        int handled = drain(&view_changed);
+        if (view_changed) {
+            app_view_t view;
+            make_view(&view);
+            view_cb(&view);
+        }
+        if (handled) {
+            ESP_LOGI(TAG, "derived values: %lu recomputed, %lu recomputations avoided", (unsigned long)recomputed,
+                     (unsigned long)avoided);
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void app_state_init(app_view_t *view) {
+    load();
+    for (int source = 0; source < APP_SOURCE_COUNT; source++) {
+        event_ring_init(&rings[source]);
+    }
+    create_deadlines();
+    day_rollover();
+    refresh();
+    make_view(view);
+}
+
+void app_state_start(app_view_cb_t cb) {
+    view_cb = cb;
+    persist_mailbox = xQueueCreate(1, sizeof(app_snapshot_t));
+    xTaskCreate(persist_task, "persist", PERSIST_TASK_STACK, NULL, PERSIST_TASK_PRIO, NULL);
+    xTaskCreate(state_task, "state", STATE_TASK_STACK, NULL, STATE_TASK_PRIO, &state_task_handle);
+}
+
+bool app_state_post(app_source_t source, app_event_type_t type, int32_t arg) {
+    event_ring_entry_t event = {
+        .time_us = esp_timer_get_time(),
+        .type = type,
+        .arg = arg,
+    };
+    bool queued = event_ring_push(&rings[source], &event);
+    // Wake the state task either way so it reports the drop
+    if (!state_task_handle) {
+        return queued;
+    }
+    xTaskNotifyGive(state_task_handle);
+    return queued;
+}
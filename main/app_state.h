@@ -0,0 +1,84 @@
+#ifndef APP_STATE_H
+#define APP_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "assets/animations/tamagotchi_state.h"
+
+// Owner of the model: word count, health, the tamagotchi state and the
+// selected icon. A state task applies input events and the daily check to
+// it and publishes a view for the UI whenever something visible changes;
+// a persistence task writes it to NVS in the background, so a slow commit
+// never holds up the UI or the renderer.
+//
+//   input --app_state_post()--> state task --view_cb--> UI task
+//                                   |
+//                                   +--mailbox--> persistence task
+//
+// Every task blocks until it has work: the state task on its task
+// notification, given with every posted event, including the one-shot
+// esp_timer deadlines it arms itself (end of the writing animation, end
+// of the celebration, next daily check); the persistence task on a
+// one-slot mailbox that always holds the latest snapshot.
+
+// The icons along the top, left to right
+typedef enum {
+    APP_ICON_WRITE,
+    APP_ICON_LOG,
+    APP_ICON_TROPHY,
+    APP_ICON_SETTINGS,
+    APP_ICON_COUNT
+} app_icon_t;
+
+typedef enum {
+    APP_BUTTON_LEFT,
+    APP_BUTTON_MIDDLE,
+    APP_BUTTON_RIGHT,
+    APP_BUTTON_COUNT
+} app_button_t;
+
+typedef enum {
+    APP_EVENT_PRESS,            // Buttons; arg is the app_button_t
+    APP_EVENT_RELEASE,
+    APP_EVENT_LONG_PRESS,
+    APP_EVENT_ICON_CLICKED,     // Touch on an icon; arg is its index
+    APP_EVENT_DEADLINE,         // A scheduled deadline fired; arg identifies it
+} app_event_type_t;
+
+// Who posts an event. Each source has its own lock-free ring and must
+// post from a single task. No source posts from an interrupt: the button
+// interrupt only records the edge time and wakes the input task, and the
+// press is posted once the debounce timer has confirmed it.
+typedef enum {
+    APP_SOURCE_INPUT,           // Button debounce timers (esp_timer task)
+    APP_SOURCE_UI,              // LVGL event callbacks (LVGL task)
+    APP_SOURCE_TIMER,           // Deadlines (esp_timer task)
+    APP_SOURCE_COUNT
+} app_source_t;
+
+// Everything the UI shows
+typedef struct {
+    int32_t words;
+    int32_t health;             // Health segments
+    int32_t selected_icon;
+    tamagotchi_anim_t anim;
+    bool anim_loop;
+    uint32_t anim_seq;          // Bumped whenever the animation must (re)start
+} app_view_t;
+
+// Called from the state task with each new view
+typedef void (*app_view_cb_t)(const app_view_t *view);
+
+// Open NVS, load the persisted state and fill in the view to build the UI
+// from. Call once before app_state_start().
+void app_state_init(app_view_t *view);
+
+// Start the state and persistence tasks
+void app_state_start(app_view_cb_t view_cb);
+
+// Timestamp an event and push it into the ring of its source for the state
+// task. Never blocks and takes no lock. Task context only.
+// Returns false if the ring is full; the state task logs the drop count.
+bool app_state_post(app_source_t source, app_event_type_t type, int32_t arg);
+
+#endif // APP_STATE_H
@@ -1,113 +1,138 @@
 #include "assets/animations/animations.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "ANIM";
+
+void animation_patch_blit(const animation_delta_t *delta, const animation_patch_t *patch, uint8_t *canvas) {
+    if (delta->bpp == ANIMATION_DELTA_RGB565) {
+        uint32_t canvas_stride = delta->width * sizeof(uint16_t);
+        for (uint16_t row = 0; row < patch->h; row++) {
+            memcpy(canvas + (patch->y + row) * canvas_stride + patch->x * sizeof(uint16_t),
+                   patch->data + row * patch->stride, patch->w * sizeof(uint16_t));
+        }
+        return;
+    }
 
-// Prehatch animation frames
-static const lv_image_dsc_t *prehatch_frames[] = {
-    &prehatch_00,
-    &prehatch_01,
-    &prehatch_02,
-    &prehatch_03,
-};
-
-// Hatched animation frames
-static const lv_image_dsc_t *hatched_frames[] = {
-    &hatched_00,
-    &hatched_01,
-    &hatched_02,
-};
-
-// Idle animation frames
-static const lv_image_dsc_t *idle_frames[] = {
-    &idle_00,
-    &idle_01,
-    &idle_02,
-    &idle_03,
-    &idle_04,
-};
-
-// Writing animation frames
-static const lv_image_dsc_t *writing_frames[] = {
-    &writing_00,
-    &writing_01,
-    &writing_02,
-    &writing_03,
-    &writing_04,
-};
-
-// Sick animation frames
-static const lv_image_dsc_t *sick_frames[] = {
-    &sick_00,
-    &sick_01,
-};
-
-// Dead animation frames
-static const lv_image_dsc_t *dead_frames[] = {
-    &dead_00,
-    &dead_01,
-    &dead_02,
-    &dead_03,
-    &dead_04,
-    &dead_05,
-    &dead_06,
-};
-
-// Celebrate animation frames
-static const lv_image_dsc_t *celebrate_frames[] = {
-    &celebrate_00,
-    &celebrate_01,
-    &celebrate_02,
-    &celebrate_03,
-    &celebrate_04,
-};
-
-// Animation definitions with FPS from animation_fps.h
-const animation_t prehatch_animation = {
-    .frames = prehatch_frames,
-    .frame_count = sizeof(prehatch_frames) / sizeof(prehatch_frames[0]),
-    .fps = ANIM_FPS_PREHATCH,
-};
-
-const animation_t hatched_animation = {
-    .frames = hatched_frames,
-    .frame_count = sizeof(hatched_frames) / sizeof(hatched_frames[0]),
-    .fps = ANIM_FPS_HATCHED,
-};
-
-const animation_t idle_animation = {
-    .frames = idle_frames,
-    .frame_count = sizeof(idle_frames) / sizeof(idle_frames[0]),
-    .fps = ANIM_FPS_IDLE,
-};
-
-const animation_t writing_animation = {
-    .frames = writing_frames,
-    .frame_count = sizeof(writing_frames) / sizeof(writing_frames[0]),
-    .fps = ANIM_FPS_WRITING,
-};
-
-const animation_t sick_animation = {
-    .frames = sick_frames,
-    .frame_count = sizeof(sick_frames) / sizeof(sick_frames[0]),
-    .fps = ANIM_FPS_SICK,
-};
-
-const animation_t dead_animation = {
-    .frames = dead_frames,
-    .frame_count = sizeof(dead_frames) / sizeof(dead_frames[0]),
-    .fps = ANIM_FPS_DEAD,
-};
-
-const animation_t celebrate_animation = {
-    .frames = celebrate_frames,
-    .frame_count = sizeof(celebrate_frames) / sizeof(celebrate_frames[0]),
-    .fps = ANIM_FPS_CELEBRATE,
-};
+    uint8_t per_byte = 8 / delta->bpp;
+    uint8_t mask = (uint8_t)((1u << delta->bpp) - 1);
+    lv_color32_t *pixels = (lv_color32_t *)canvas;
+
+    for (uint16_t row = 0; row < patch->h; row++) {
+        const uint8_t *src = patch->data + row * patch->stride;
+        lv_color32_t *dst = pixels + (patch->y + row) * delta->width + patch->x;
+        if (delta->bpp == 8) {
+            for (uint16_t col = 0; col < patch->w; col++) {
+                dst[col] = delta->palette[src[col]];
+            }
+            continue;
+        }
+        for (uint16_t col = 0; col < patch->w; col++) {
+            uint8_t shift = (per_byte - 1 - col % per_byte) * delta->bpp;
+            dst[col] = delta->palette[(src[col / per_byte] >> shift) & mask];
+        }
+    }
+}
+
+static bool animation_player_ensure_canvas(animation_player_t *player, const animation_delta_t *delta) {
+    uint32_t size = (uint32_t)delta->width * delta->height * animation_delta_pixel_size(delta);
+    if (size <= player->canvas_capacity) return true;
+
+    heap_caps_free(player->canvas_buf);
+    player->canvas_buf = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!player->canvas_buf) {
+        player->canvas_buf = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+    }
+    player->canvas_capacity = player->canvas_buf ? size : 0;
+    if (!player->canvas_buf) {
+        ESP_LOGE(TAG, "no memory for %ux%u delta canvas", delta->width, delta->height);
+        return false;
+    }
+    return true;
+}
+
+// Rebuild the delta canvas for an arbitrary frame: keyframe, then every
+// patch up to frame_index. Used when (re)starting, not for normal playback.
+static void animation_player_show_delta_frame(animation_player_t *player, uint16_t frame_index) {
+    const animation_delta_t *delta = player->animation->delta;
+    if (!animation_player_ensure_canvas(player, delta)) {
+        player->playing = false;
+        return;
+    }
+
+    animation_patch_blit(delta, delta->keyframe, player->canvas_buf);
+    for (uint16_t f = 1; f <= frame_index; f++) {
+        for (uint16_t i = 0; i < delta->frames[f].patch_count; i++) {
+            animation_patch_blit(delta, &delta->frames[f].patches[i], player->canvas_buf);
+        }
+    }
+
+    // Same descriptor as the previous delta animation, but possibly a new size
+    lv_image_cache_drop(&player->canvas_dsc);
+    player->canvas_dsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    uint8_t pixel_size = animation_delta_pixel_size(delta);
+    player->canvas_dsc.header.cf = delta->bpp == ANIMATION_DELTA_RGB565 ? LV_COLOR_FORMAT_RGB565
+                                                                        : LV_COLOR_FORMAT_ARGB8888;
+    player->canvas_dsc.header.w = delta->width;
+    player->canvas_dsc.header.h = delta->height;
+    player->canvas_dsc.header.stride = delta->width * pixel_size;
+    player->canvas_dsc.data_size = (uint32_t)delta->width * delta->height * pixel_size;
+    player->canvas_dsc.data = player->canvas_buf;
+    lv_image_set_src(player->image_obj, &player->canvas_dsc);
+    lv_obj_set_pos(player->image_obj, player->origin_x + delta->x, player->origin_y + delta->y);
+}
+
+// Advance a delta animation by one frame: apply the frame's patches in
+// place and invalidate only the rectangles they cover.
+static void animation_player_step_delta(animation_player_t *player, uint16_t frame_index) {
+    const animation_delta_t *delta = player->animation->delta;
+    if (!player->canvas_buf) return;  // Canvas allocation failed
+    const animation_delta_frame_t *frame = &delta->frames[frame_index];
+    lv_area_t coords;
+    lv_obj_get_coords(player->image_obj, &coords);
+
+    for (uint16_t i = 0; i < frame->patch_count; i++) {
+        const animation_patch_t *patch = &frame->patches[i];
+        animation_patch_blit(delta, patch, player->canvas_buf);
+
+        lv_area_t area = {
+            .x1 = coords.x1 + patch->x,
+            .y1 = coords.y1 + patch->y,
+            .x2 = coords.x1 + patch->x + patch->w - 1,
+            .y2 = coords.y1 + patch->y + patch->h - 1,
+        };
+        lv_obj_invalidate_area(player->image_obj, &area);
+    }
+}
+
+// Show a frame: swap the image and move the object to the frame's offset.
+// Both calls invalidate only the old and new trimmed areas.
+static void animation_player_show_frame(animation_player_t *player, uint16_t frame_index) {
+    if (player->animation->delta) {
+        animation_player_show_delta_frame(player, frame_index);
+        return;
+    }
+    const animation_frame_t *frame = &player->animation->frames[frame_index];
+    lv_image_set_src(player->image_obj, frame->image);
+    lv_obj_set_pos(player->image_obj, player->origin_x + frame->x, player->origin_y + frame->y);
+}
+
+// A delta animation can only play once its canvas is allocated
+static bool animation_player_can_play(const animation_player_t *player) {
+    return !player->animation->delta || player->canvas_buf;
+}
 
 // Animation player functions
 void animation_player_init(animation_player_t *player, const animation_t *anim, lv_obj_t *img_obj, bool loop) {
     player->animation = anim;
     player->image_obj = img_obj;
+    player->origin_x = img_obj ? lv_obj_get_style_x(img_obj, LV_PART_MAIN) : 0;
+    player->origin_y = img_obj ? lv_obj_get_style_y(img_obj, LV_PART_MAIN) : 0;
+    player->canvas_buf = NULL;
+    player->canvas_capacity = 0;
     player->current_frame = 0;
     player->last_update_ms = 0;
     player->playing = false;
@@ -115,13 +140,18 @@ void animation_player_init(animation_player_t *player, const animation_t *anim,
     
     // Set initial frame
     if (anim && anim->frame_count > 0 && img_obj) {
-        lv_image_set_src(img_obj, anim->frames[0]);
+        animation_player_show_frame(player, 0);
     }
 }
 
 void animation_player_start(animation_player_t *player) {
     if (player->animation && player->animation->frame_count > 0) {
-        player->playing = true;
+        // Delta playback relies on the canvas holding the current frame; a
+        // canvas that could not be allocated before is retried here
+        if ((player->current_frame != 0 || !animation_player_can_play(player)) && player->image_obj) {
+            animation_player_show_frame(player, 0);
+        }
+        player->playing = animation_player_can_play(player);
         player->current_frame = 0;
         player->last_update_ms = 0;
     }
@@ -136,7 +166,7 @@ void animation_player_set_frame(animation_player_t *player, uint16_t frame_index
     
     if (frame_index < player->animation->frame_count) {
         player->current_frame = frame_index;
-        lv_image_set_src(player->image_obj, player->animation->frames[frame_index]);
+        animation_player_show_frame(player, frame_index);
     }
 }
 
@@ -145,16 +175,32 @@ void animation_player_set_animation(animation_player_t *player, const animation_
     player->loop = loop;
     player->current_frame = 0;
     player->last_update_ms = 0;
-    player->playing = true;
+    player->playing = false;
     
     if (anim && anim->frame_count > 0 && player->image_obj) {
-        lv_image_set_src(player->image_obj, anim->frames[0]);
+        animation_player_show_frame(player, 0);
+        player->playing = animation_player_can_play(player);
     }
 }
 
+uint32_t animation_duration_ms(const animation_t *anim) {
+    if (!anim || anim->fps == 0) return 0;
+    return anim->frame_count * (1000 / anim->fps);
+}
+
+uint32_t animation_player_ms_until_update(const animation_player_t *player, uint32_t current_time_ms) {
+    if (!player->playing || !player->animation || !player->image_obj) return UINT32_MAX;
+    if (player->animation->frame_count == 0) return UINT32_MAX;
+    if (player->last_update_ms == 0) return 0;
+
+    uint32_t elapsed = current_time_ms - player->last_update_ms;
+    uint32_t ms_per_frame = 1000 / player->animation->fps;
+    return elapsed >= ms_per_frame ? 0 : ms_per_frame - elapsed;
+}
+
 void animation_player_update(animation_player_t *player, uint32_t current_time_ms) {
     if (!player->playing || !player->animation || !player->image_obj) return;
-    if (player->animation->frame_count == 0) return;
+    if (player->animation->frame_count == 0 || !animation_player_can_play(player)) return;
     
     // Calculate milliseconds per frame based on animation's FPS
     uint32_t ms_per_frame = 1000 / player->animation->fps;
@@ -183,7 +229,11 @@ void animation_player_update(animation_player_t *player, uint32_t current_time_m
         }
         
         // Update the image
-        lv_image_set_src(player->image_obj, player->animation->frames[player->current_frame]);
+        if (player->animation->delta) {
+            animation_player_step_delta(player, player->current_frame);
+        } else {
+            animation_player_show_frame(player, player->current_frame);
+        }
         
         // Update timing (account for frame time overflow)
         player->last_update_ms += ms_per_frame;
@@ -6,77 +6,87 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-// Animation structure to hold frame data and metadata
+// One frame of an animation. Frames are trimmed to their visible pixels by
+// tools/sprite_convert.py, so each image only covers the dinosaur and is
+// placed at (x, y) inside the animation canvas. Images share a palette
+// per animation (LV_COLOR_FORMAT_I1..I8), or are ARGB8888 when a frame
+// exceeds the palette budget. LVGL decodes either format natively.
+typedef struct {
+    const lv_image_dsc_t *image;    // Trimmed frame image
+    int16_t x;                      // Offset of the image inside the canvas
+    int16_t y;
+} animation_frame_t;
+
+// Delta-encoded animations keep one keyframe plus, per frame, the
+// rectangles that changed since the previous frame. Rectangles hold packed
+// indices into the animation's shared palette, or RGB565 pixels already
+// blended over the background (ANIMATION_DELTA_RGB565), and sit inside an
+// atlas page, so consecutive rows are `stride` bytes apart.
+typedef struct {
+    uint16_t x;                     // Position inside the delta canvas
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint16_t stride;                // Bytes from one row to the next
+    const uint8_t *data;            // Indices or pixels of the top-left pixel's byte
+} animation_patch_t;
+
+typedef struct {
+    const animation_patch_t *patches;  // Changes from the previous frame (frame 0: from the last)
+    uint16_t patch_count;
+} animation_delta_frame_t;
+
+// Pre-composited delta animations (sprite_convert.py --composite) keep an
+// opaque RGB565 canvas: LVGL copies it without blending and skips drawing
+// the background underneath.
+#define ANIMATION_DELTA_RGB565 16
+
+typedef struct {
+    const lv_color32_t *palette;    // Shared palette, (1 << bpp) entries; NULL for RGB565
+    uint8_t bpp;                    // Bits per index: 1, 2, 4 or 8, or ANIMATION_DELTA_RGB565
+    int16_t x;                      // Delta canvas position inside the animation canvas;
+    int16_t y;                      // the canvas is the union of all frames' visible pixels
+    uint16_t width;
+    uint16_t height;
+    const animation_patch_t *keyframe;      // Frame 0, covering the whole delta canvas
+    const animation_delta_frame_t *frames;  // frame_count entries
+} animation_delta_t;
+
+// Animation structure to hold frame data and metadata. Exactly one of
+// frames/delta is set; tools/sprite_convert.py picks delta encoding when
+// the changed rectangles are much smaller than the trimmed frames.
 typedef struct animation_t {
-    const lv_image_dsc_t **frames;  // Array of pointers to frame image descriptors
-    uint16_t frame_count;           // Number of frames in the animation
-    uint16_t fps;                   // Frames per second (default playback speed)
+    const animation_frame_t *frames;  // Frame table, built from the asset container
+    const animation_delta_t *delta;   // Keyframe + patches, built from the asset container
+    uint16_t frame_count;             // Number of frames in the animation
+    uint16_t fps;                     // Frames per second (default playback speed)
 } animation_t;
 
 // Animation player state
 typedef struct {
     const animation_t *animation;
     lv_obj_t *image_obj;            // LVGL image object to update
+    int32_t origin_x;               // Canvas anchor, taken from image_obj at init
+                                    // (top-right in native orientation)
+    int32_t origin_y;
     uint16_t current_frame;         // Current frame index (0-based)
     uint32_t last_update_ms;        // Last frame update time in milliseconds
     bool playing;                    // Whether animation is currently playing
     bool loop;                       // Whether to loop the animation
+    lv_image_dsc_t canvas_dsc;      // Delta animations: ARGB8888 (RGB565) image of the current frame
+    uint8_t *canvas_buf;            // Pixels of canvas_dsc (PSRAM when available)
+    uint32_t canvas_capacity;       // Allocated bytes in canvas_buf
 } animation_player_t;
 
-// Forward declarations for all animation frames
-// Prehatch frames
-LV_IMAGE_DECLARE(prehatch_00);
-LV_IMAGE_DECLARE(prehatch_01);
-LV_IMAGE_DECLARE(prehatch_02);
-LV_IMAGE_DECLARE(prehatch_03);
-
-// Hatched frames
-LV_IMAGE_DECLARE(hatched_00);
-LV_IMAGE_DECLARE(hatched_01);
-LV_IMAGE_DECLARE(hatched_02);
-
-// Idle frames
-LV_IMAGE_DECLARE(idle_00);
-LV_IMAGE_DECLARE(idle_01);
-LV_IMAGE_DECLARE(idle_02);
-LV_IMAGE_DECLARE(idle_03);
-LV_IMAGE_DECLARE(idle_04);
-
-// Writing frames
-LV_IMAGE_DECLARE(writing_00);
-LV_IMAGE_DECLARE(writing_01);
-LV_IMAGE_DECLARE(writing_02);
-LV_IMAGE_DECLARE(writing_03);
-LV_IMAGE_DECLARE(writing_04);
-
-// Sick frames
-LV_IMAGE_DECLARE(sick_00);
-LV_IMAGE_DECLARE(sick_01);
-
-// Dead frames
-LV_IMAGE_DECLARE(dead_00);
-LV_IMAGE_DECLARE(dead_01);
-LV_IMAGE_DECLARE(dead_02);
-LV_IMAGE_DECLARE(dead_03);
-LV_IMAGE_DECLARE(dead_04);
-LV_IMAGE_DECLARE(dead_05);
-LV_IMAGE_DECLARE(dead_06);
-
-// Celebrate frames
-LV_IMAGE_DECLARE(celebrate_00);
-LV_IMAGE_DECLARE(celebrate_01);
-LV_IMAGE_DECLARE(celebrate_02);
-LV_IMAGE_DECLARE(celebrate_03);
-LV_IMAGE_DECLARE(celebrate_04);
-
-// Animation definitions (extern, defined in animations.c)
-extern const animation_t prehatch_animation;
-extern const animation_t hatched_animation;
-extern const animation_t idle_animation;
-extern const animation_t writing_animation;
-extern const animation_t sick_animation;
-extern const animation_t dead_animation;
-extern const animation_t celebrate_animation;
+// Animation definitions, filled in from the asset container by
+// asset_store_init() (assets/asset_store.c)
+extern animation_t prehatch_animation;
+extern animation_t hatched_animation;
+extern animation_t idle_animation;
+extern animation_t writing_animation;
+extern animation_t sick_animation;
+extern animation_t dead_animation;
+extern animation_t celebrate_animation;
 
 // Function prototypes
 void animation_player_init(animation_player_t *player, const animation_t *anim, lv_obj_t *img_obj, bool loop);
@@ -85,5 +95,19 @@ void animation_player_stop(animation_player_t *player);
 void animation_player_update(animation_player_t *player, uint32_t current_time_ms);
 void animation_player_set_frame(animation_player_t *player, uint16_t frame_index);
 void animation_player_set_animation(animation_player_t *player, const animation_t *anim, bool loop);
+// Time one pass over every frame takes at the animation's fps
+uint32_t animation_duration_ms(const animation_t *anim);
+// Milliseconds until animation_player_update() has a frame to show;
+// UINT32_MAX once the player has stopped
+uint32_t animation_player_ms_until_update(const animation_player_t *player, uint32_t current_time_ms);
+
+// Bytes per delta canvas pixel: ARGB8888, or RGB565 when pre-composited
+static inline uint8_t animation_delta_pixel_size(const animation_delta_t *delta) {
+    return delta->bpp == ANIMATION_DELTA_RGB565 ? sizeof(uint16_t) : sizeof(lv_color32_t);
+}
+
+// Expand a patch's palette indices into an ARGB8888 delta canvas, or copy
+// its RGB565 rows into an RGB565 one (delta->width pixels per row).
+void animation_patch_blit(const animation_delta_t *delta, const animation_patch_t *patch, uint8_t *canvas);
 
 #endif // ANIMATIONS_H
@@ -0,0 +1,375 @@
+#include "assets/animations/sprite_bench.h"
+#include "sdkconfig.h"
+
+#if CONFIG_TAMA_SPRITE_BENCHMARK
+#include "assets/animations/sprite_rle.h"
+#include "assets/animations/sprite_blend.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ui_layout.h"
+#include <inttypes.h>
+#include <string.h>
+
+static const char *TAG = "BENCH";
+
+#define SPRITE_BENCH_ITERATIONS 50
+
+// Frame 0 of each benchmarked animation from the trimmed RLE container
+// main/CMakeLists.txt builds for the benchmark, byte for byte as
+// tools/sprite_convert.py --format rle stores it
+extern const uint8_t bench_idle_rle_start[] asm("_binary_bench_idle_rle_start");
+extern const uint8_t bench_idle_rle_end[] asm("_binary_bench_idle_rle_end");
+extern const uint8_t bench_celebrate_rle_start[] asm("_binary_bench_celebrate_rle_start");
+extern const uint8_t bench_celebrate_rle_end[] asm("_binary_bench_celebrate_rle_end");
+extern const uint8_t bench_writing_rle_start[] asm("_binary_bench_writing_rle_start");
+extern const uint8_t bench_writing_rle_end[] asm("_binary_bench_writing_rle_end");
+
+static const struct {
+    const char *name;
+    const uint8_t *start;
+    const uint8_t *end;
+} bench_frames[] = {
+    {"idle", bench_idle_rle_start, bench_idle_rle_end},
+    {"celebrate", bench_celebrate_rle_start, bench_celebrate_rle_end},
+    {"writing", bench_writing_rle_start, bench_writing_rle_end},
+};
+
+// Palette indices of one RLE row, packed MSB first as LVGL's indexed
+// formats expect
+static void bench_rle_indices(const uint8_t *rle, uint16_t row, uint8_t bpp, uint8_t *out) {
+    sprite_rle_header_t header;
+    memcpy(&header, rle, sizeof(header));
+    const uint8_t *offsets = rle + sizeof(header) + header.palette_size * sizeof(lv_color32_t);
+    uint32_t offset;
+    memcpy(&offset, offsets + row * sizeof(uint32_t), sizeof(offset));
+    const uint8_t *src = offsets + header.height * sizeof(uint32_t) + offset;
+
+    uint8_t per_byte = 8 / bpp;
+    memset(out, 0, (header.width * bpp + 7) / 8);
+    uint16_t x = 0;
+    while (x < header.width) {
+        uint8_t packet = *src++;
+        uint16_t count = (packet & 0x7f) + 1;
+        for (uint16_t i = 0; i < count; i++, x++) {
+            uint8_t index = (packet & 0x80) ? *src++ : *src;
+            out[x / per_byte] |= index << ((per_byte - 1 - x % per_byte) * bpp);
+        }
+        if (!(packet & 0x80)) src++;
+    }
+}
+
+static uint8_t bench_index_bpp(uint16_t palette_size) {
+    uint8_t bpp = 1;
+    while ((1u << bpp) < palette_size) bpp *= 2;
+    return bpp;
+}
+
+static int64_t bench_draw_dsc(lv_obj_t *canvas, const lv_draw_image_dsc_t *dsc, const lv_area_t *area,
+                              bool drop_cache) {
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < SPRITE_BENCH_ITERATIONS; i++) {
+        if (drop_cache) {
+            lv_image_cache_drop(dsc->src);
+        }
+        lv_layer_t layer;
+        lv_canvas_init_layer(canvas, &layer);
+        lv_draw_image(&layer, dsc, area);
+        lv_canvas_finish_layer(canvas, &layer);
+    }
+    return (esp_timer_get_time() - start) / SPRITE_BENCH_ITERATIONS;
+}
+
+static int64_t bench_draw(lv_obj_t *canvas, const lv_image_dsc_t *image, bool drop_cache) {
+    lv_draw_image_dsc_t dsc;
+    lv_draw_image_dsc_init(&dsc);
+    dsc.src = image;
+    lv_area_t area = {0, 0, image->header.w - 1, image->header.h - 1};
+    return bench_draw_dsc(canvas, &dsc, &area, drop_cache);
+}
+
+static void bench_report(const char *name, int64_t us, uint32_t bytes, uint32_t pixels) {
+    ESP_LOGI(TAG, "%-8s %6lu bytes  %6lld us/draw  %5.2f Mpx/s", name, (unsigned long)bytes, (long long)us,
+             us > 0 ? (double)pixels / us : 0.0);
+}
+
+// One blend kernel on its own over a fixed background, the result checked
+// against sprite_blend_reference(), a C copy of LVGL's per-pixel loop.
+// LVGL's own loop is timed by the ARGB8888 row of bench_formats().
+static void bench_blend_kernel(const char *name, sprite_blend_fn_t blend, const lv_color32_t *raw, uint16_t w,
+                               uint16_t h, uint16_t *dst, const uint16_t *expected) {
+    int64_t total = 0;
+    for (int i = 0; i < SPRITE_BENCH_ITERATIONS; i++) {
+        for (uint32_t p = 0; p < (uint32_t)w * h; p++) {
+            dst[p] = (uint16_t)(p * 0x9e37);
+        }
+        int64_t start = esp_timer_get_time();
+        blend(dst, w * sizeof(uint16_t), (const uint32_t *)raw, w * sizeof(uint32_t), w, h);
+        total += esp_timer_get_time() - start;
+    }
+    bench_report(name, total / SPRITE_BENCH_ITERATIONS, (uint32_t)w * h * sizeof(uint32_t), (uint32_t)w * h);
+    if (expected && memcmp(dst, expected, (size_t)w * h * sizeof(uint16_t)) != 0) {
+        ESP_LOGE(TAG, "%s differs from the reference blend", name);
+    }
+}
+
+// The animation canvas the sprite object covers
+#if UI_NATIVE_ORIENTATION
+#define BENCH_CANVAS_W 210
+#define BENCH_CANVAS_H 367
+#else
+#define BENCH_CANVAS_W 367
+#define BENCH_CANVAS_H 210
+#endif
+
+static void bench_blend_canvas(const char *what, const lv_color32_t *canvas, uint16_t *dst, uint16_t *expected) {
+    uint32_t pixels = BENCH_CANVAS_W * BENCH_CANVAS_H;
+    uint32_t partial = 0;
+    for (uint32_t p = 0; p < pixels; p++) {
+        partial += canvas[p].alpha > 0 && canvas[p].alpha < LV_OPA_COVER;
+    }
+    ESP_LOGI(TAG, "ARGB8888 over RGB565, %dx%d %s, %lu px with partial alpha", BENCH_CANVAS_W, BENCH_CANVAS_H,
+             what, (unsigned long)partial);
+    bench_blend_kernel("C ref", sprite_blend_reference, canvas, BENCH_CANVAS_W, BENCH_CANVAS_H, expected, NULL);
+    bench_blend_kernel("masked", sprite_blend_masked, canvas, BENCH_CANVAS_W, BENCH_CANVAS_H, dst, expected);
+}
+
+// The keyframe centred in a transparent sprite-sized canvas, as the sprite
+// object draws it, then the same canvas with every pixel at half alpha to
+// time the mixing path on its own. The destination sits in internal RAM
+// like LVGL's draw buffers when there is room.
+static void bench_blend(const lv_color32_t *raw, uint16_t w, uint16_t h) {
+    size_t pixels = BENCH_CANVAS_W * BENCH_CANVAS_H;
+    lv_color32_t *canvas = heap_caps_aligned_alloc(16, pixels * sizeof(lv_color32_t), MALLOC_CAP_SPIRAM);
+    uint16_t *expected = heap_caps_malloc(pixels * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    uint16_t *dst = heap_caps_aligned_alloc(16, pixels * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    if (!dst) dst = heap_caps_aligned_alloc(16, pixels * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    if (canvas && expected && dst && w <= BENCH_CANVAS_W && h <= BENCH_CANVAS_H) {
+        memset(canvas, 0, pixels * sizeof(lv_color32_t));
+        uint32_t x0 = (BENCH_CANVAS_W - w) / 2, y0 = (BENCH_CANVAS_H - h) / 2;
+        for (uint16_t y = 0; y < h; y++) {
+            memcpy(canvas + (y0 + y) * BENCH_CANVAS_W + x0, raw + y * w, w * sizeof(lv_color32_t));
+        }
+        bench_blend_canvas("sprite", canvas, dst, expected);
+
+        for (size_t p = 0; p < pixels; p++) {
+            canvas[p].alpha = LV_OPA_50;
+        }
+        bench_blend_canvas("half alpha", canvas, dst, expected);
+    } else {
+        ESP_LOGE(TAG, "no memory for blend buffers");
+    }
+    heap_caps_free(canvas);
+    heap_caps_free(expected);
+    heap_caps_free(dst);
+}
+
+static void bench_formats(const uint8_t *rle, uint32_t rle_size, lv_color32_t *raw, uint8_t *indexed,
+                          lv_draw_buf_t *target) {
+    sprite_rle_header_t header;
+    memcpy(&header, rle, sizeof(header));
+    uint16_t w = header.width, h = header.height;
+    uint32_t pixels = (uint32_t)w * h;
+    uint8_t bpp = bench_index_bpp(header.palette_size);
+    uint32_t palette_bytes = (1u << bpp) * sizeof(lv_color32_t);
+    uint32_t index_stride = (w * bpp + 7) / 8;
+
+    for (uint16_t y = 0; y < h; y++) {
+        sprite_rle_decode_row(rle, y, raw + y * w);
+    }
+    lv_image_dsc_t raw_dsc = {
+        .header.magic = LV_IMAGE_HEADER_MAGIC,
+        .header.cf = LV_COLOR_FORMAT_ARGB8888,
+        .header.w = w,
+        .header.h = h,
+        .header.stride = w * sizeof(lv_color32_t),
+        .data_size = pixels * sizeof(lv_color32_t),
+        .data = (const uint8_t *)raw,
+    };
+
+    static const lv_color_format_t indexed_cf[] = {
+        [1] = LV_COLOR_FORMAT_I1, [2] = LV_COLOR_FORMAT_I2, [4] = LV_COLOR_FORMAT_I4, [8] = LV_COLOR_FORMAT_I8,
+    };
+    memset(indexed, 0, palette_bytes);
+    memcpy(indexed, rle + sizeof(header), header.palette_size * sizeof(lv_color32_t));
+    for (uint16_t y = 0; y < h; y++) {
+        bench_rle_indices(rle, y, bpp, indexed + palette_bytes + y * index_stride);
+    }
+    lv_image_dsc_t indexed_dsc = {
+        .header.magic = LV_IMAGE_HEADER_MAGIC,
+        .header.cf = indexed_cf[bpp],
+        .header.w = w,
+        .header.h = h,
+        .header.stride = index_stride,
+        .data_size = palette_bytes + index_stride * h,
+        .data = indexed,
+    };
+
+    lv_image_dsc_t rle_dsc = {
+        .header.magic = LV_IMAGE_HEADER_MAGIC,
+        .header.cf = LV_COLOR_FORMAT_RAW_ALPHA,
+        .header.w = w,
+        .header.h = h,
+        .data_size = rle_size,
+        .data = rle,
+    };
+
+    lv_obj_t *canvas = lv_canvas_create(lv_screen_active());
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, target);
+
+    ESP_LOGI(TAG, "%ux%u frame, %u colours, %d draws each", w, h, header.palette_size, SPRITE_BENCH_ITERATIONS);
+    // The formats are compared through LVGL's own blender. The indexed
+    // image is decoded to ARGB8888 on open; drop the cached copy so every
+    // draw pays for the decode like a cold frame does.
+    sprite_blend_hook_set_enabled(false);
+    bench_report("ARGB8888", bench_draw(canvas, &raw_dsc, false), raw_dsc.data_size, pixels);
+    bench_report("indexed", bench_draw(canvas, &indexed_dsc, true), indexed_dsc.data_size, pixels);
+    bench_report("RLE", bench_draw(canvas, &rle_dsc, false), rle_dsc.data_size, pixels);
+    sprite_blend_hook_set_enabled(true);
+#if CONFIG_TAMA_SPRITE_BLEND
+    bench_report("+kernel", bench_draw(canvas, &raw_dsc, false), raw_dsc.data_size, pixels);
+#endif
+
+    lv_obj_delete(canvas);
+    bench_blend(raw, w, h);
+}
+
+// A pre-composited keyframe is drawn straight from the atlas page: an
+// opaque RGB565 copy with no decode and no blending
+static void bench_composited(const animation_delta_t *delta, lv_draw_buf_t *target) {
+    const animation_patch_t *key = delta->keyframe;
+    uint32_t pixels = (uint32_t)key->w * key->h;
+    lv_image_dsc_t dsc = {
+        .header.magic = LV_IMAGE_HEADER_MAGIC,
+        .header.cf = LV_COLOR_FORMAT_RGB565,
+        .header.w = key->w,
+        .header.h = key->h,
+        .header.stride = key->stride,
+        .data_size = (uint32_t)(key->h - 1) * key->stride + key->w * sizeof(uint16_t),
+        .data = key->data,
+    };
+
+    lv_obj_t *canvas = lv_canvas_create(lv_screen_active());
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, target);
+    ESP_LOGI(TAG, "%ux%u keyframe, pre-composited, %d draws", key->w, key->h, SPRITE_BENCH_ITERATIONS);
+    bench_report("RGB565", bench_draw(canvas, &dsc, false), pixels * sizeof(uint16_t), pixels);
+    lv_obj_delete(canvas);
+}
+
+void sprite_bench_run(const char *name, const animation_t *anim) {
+    const animation_delta_t *delta = anim->delta;
+    if (delta && delta->bpp == ANIMATION_DELTA_RGB565) {
+        lv_draw_buf_t *target = lv_draw_buf_create(delta->keyframe->w, delta->keyframe->h,
+                                                   LV_COLOR_FORMAT_RGB565, 0);
+        if (target) {
+            bench_composited(delta, target);
+            lv_draw_buf_destroy(target);
+        } else {
+            ESP_LOGE(TAG, "no memory for benchmark buffers");
+        }
+    }
+
+    const uint8_t *rle = NULL;
+    uint32_t rle_size = 0;
+    for (size_t i = 0; i < sizeof(bench_frames) / sizeof(bench_frames[0]); i++) {
+        if (strcmp(bench_frames[i].name, name) == 0) {
+            rle = bench_frames[i].start;
+            rle_size = bench_frames[i].end - bench_frames[i].start;
+        }
+    }
+    if (!rle || rle_size < sizeof(sprite_rle_header_t)) {
+        ESP_LOGW(TAG, "no benchmark frame for %s", name);
+        return;
+    }
+    sprite_rle_header_t header;
+    memcpy(&header, rle, sizeof(header));
+    uint32_t pixels = (uint32_t)header.width * header.height;
+    uint8_t bpp = bench_index_bpp(header.palette_size);
+    uint32_t indexed_bytes = (1u << bpp) * sizeof(lv_color32_t) + (header.width * bpp + 7) / 8 * header.height;
+
+    lv_color32_t *raw = heap_caps_malloc(pixels * sizeof(lv_color32_t), MALLOC_CAP_SPIRAM);
+    uint8_t *indexed = heap_caps_malloc(indexed_bytes, MALLOC_CAP_SPIRAM);
+    lv_draw_buf_t *target = lv_draw_buf_create(header.width, header.height, LV_COLOR_FORMAT_RGB565, 0);
+    if (raw && indexed && target) {
+        bench_formats(rle, rle_size, raw, indexed, target);
+    } else {
+        ESP_LOGE(TAG, "no memory for benchmark buffers");
+    }
+
+    if (target) lv_draw_buf_destroy(target);
+    heap_caps_free(raw);
+    heap_caps_free(indexed);
+}
+
+#define BENCH_ICON_CELL 60
+
+// images/write_icon.png as raw ARGB8888, unscaled (main/CMakeLists.txt)
+extern const uint8_t bench_write_icon_argb_start[] asm("_binary_bench_write_icon_argb_start");
+extern const uint8_t bench_write_icon_argb_end[] asm("_binary_bench_write_icon_argb_end");
+
+static void bench_icons(const lv_image_dsc_t *icon, const lv_image_dsc_t *selected, lv_draw_buf_t *target) {
+    uint32_t w = icon->header.w, h = icon->header.h;
+    lv_image_dsc_t source_dsc = {
+        .header.magic = LV_IMAGE_HEADER_MAGIC,
+        .header.cf = LV_COLOR_FORMAT_ARGB8888,
+        .header.w = BENCH_ICON_CELL,
+        .header.h = BENCH_ICON_CELL,
+        .header.stride = BENCH_ICON_CELL * sizeof(lv_color32_t),
+        .data_size = BENCH_ICON_CELL * BENCH_ICON_CELL * sizeof(lv_color32_t),
+        .data = bench_write_icon_argb_start,
+    };
+
+    lv_obj_t *canvas = lv_canvas_create(lv_screen_active());
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, target);
+
+    // What lv_image_set_scale() and the white recolor style used to do
+    lv_draw_image_dsc_t scaled;
+    lv_draw_image_dsc_init(&scaled);
+    scaled.src = &source_dsc;
+    scaled.scale_x = scaled.scale_y = w * 256 / BENCH_ICON_CELL;
+    scaled.pivot.x = scaled.pivot.y = BENCH_ICON_CELL / 2;
+    lv_area_t cell = {0, 0, BENCH_ICON_CELL - 1, BENCH_ICON_CELL - 1};
+    lv_draw_image_dsc_t recolored = scaled;
+    recolored.recolor = lv_color_white();
+    recolored.recolor_opa = LV_OPA_COVER;
+
+    lv_draw_image_dsc_t plain;
+    lv_draw_image_dsc_init(&plain);
+    plain.src = icon;
+    lv_draw_image_dsc_t inverted = plain;
+    inverted.src = selected;
+    int32_t ofs = (BENCH_ICON_CELL - (int32_t)w) / 2;
+    lv_area_t centred = {ofs, ofs, ofs + (int32_t)w - 1, ofs + (int32_t)h - 1};
+
+    ESP_LOGI(TAG, "icon %" PRIu32 "x%" PRIu32 " in a %dx%d cell, %d draws each", w, h, BENCH_ICON_CELL,
+             BENCH_ICON_CELL, SPRITE_BENCH_ITERATIONS);
+    bench_report("scaled", bench_draw_dsc(canvas, &scaled, &cell, false), source_dsc.data_size, w * h);
+    bench_report("+recolor", bench_draw_dsc(canvas, &recolored, &cell, false), source_dsc.data_size, w * h);
+    bench_report("baked", bench_draw_dsc(canvas, &plain, &centred, false), icon->data_size, w * h);
+    bench_report("baked sel", bench_draw_dsc(canvas, &inverted, &centred, false), selected->data_size, w * h);
+    lv_obj_delete(canvas);
+}
+
+void sprite_bench_icon(const lv_image_dsc_t *icon, const lv_image_dsc_t *selected) {
+    if (!icon->data || !selected->data || icon->header.cf != LV_COLOR_FORMAT_ARGB8888) {
+        ESP_LOGW(TAG, "icon benchmark needs ARGB8888 icons");
+        return;
+    }
+    if (bench_write_icon_argb_end - bench_write_icon_argb_start !=
+        BENCH_ICON_CELL * BENCH_ICON_CELL * sizeof(lv_color32_t)) {
+        ESP_LOGW(TAG, "icon benchmark needs a %dx%d write_icon.png", BENCH_ICON_CELL, BENCH_ICON_CELL);
+        return;
+    }
+    lv_draw_buf_t *target = lv_draw_buf_create(BENCH_ICON_CELL, BENCH_ICON_CELL, LV_COLOR_FORMAT_RGB565, 0);
+    if (target) {
+        bench_icons(icon, selected, target);
+        lv_draw_buf_destroy(target);
+    } else {
+        ESP_LOGE(TAG, "no memory for benchmark buffers");
+    }
+}
+
+#endif // CONFIG_TAMA_SPRITE_BENCHMARK
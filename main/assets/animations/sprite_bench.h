@@ -0,0 +1,24 @@
+#ifndef SPRITE_BENCH_H
+#define SPRITE_BENCH_H
+
+#include "assets/animations/animations.h"
+
+// Draw frame 0 of the named animation, as the converter stores it with
+// --delta off --format rle, into an off-screen RGB565 canvas as ARGB8888
+// (the decoded array), LVGL indexed and RLE, and log the average
+// decode+blend time of each through LVGL's own blender, then ARGB8888
+// once more through the sprite blend hook. Then time the ARGB8888 blend
+// kernels alone on a 367x210 sprite canvas holding the frame and on one
+// at half alpha, and check them against a C copy of LVGL's mix; a
+// pre-composited animation's RGB565 keyframe is timed first. Call with the
+// display lock held. Built only with CONFIG_TAMA_SPRITE_BENCHMARK.
+void sprite_bench_run(const char *name, const animation_t *anim);
+
+// Draw write_icon the way the UI used to (its 60x60 ARGB8888 source PNG,
+// embedded for the benchmark, scaled to the icon's size, then also
+// recoloured white for the selected state) and the converter's pre-scaled
+// and pre-inverted images as they are drawn now, and log the average time
+// per draw. Call with the display lock held.
+void sprite_bench_icon(const lv_image_dsc_t *icon, const lv_image_dsc_t *selected);
+
+#endif // SPRITE_BENCH_H
@@ -0,0 +1,88 @@
+#include "lvgl.h"
+#include "assets/animations/sprite_blend.h"
+#include "assets/animations/sprite_blend_lvgl.h"
+
+#define ROW(type, base, stride, y) ((type *)((uint8_t *)(base) + (y) * (stride)))
+
+static inline uint16_t argb_to_rgb565(uint32_t px) {
+    return ((px >> 8) & 0xf800) | ((px >> 5) & 0x07e0) | ((px >> 3) & 0x001f);
+}
+
+// lv_color_24_16_mix() for 0 < alpha < 255
+static inline uint16_t mix_rgb565(uint32_t px, uint16_t bg) {
+    uint32_t mix = px >> 24;
+    uint32_t inv = 255 - mix;
+    uint32_t r = (px >> 19) & 0x1f;
+    uint32_t g = (px >> 10) & 0x3f;
+    uint32_t b = (px >> 3) & 0x1f;
+    return (((r * mix + ((bg >> 11) & 0x1f) * inv) << 3) & 0xf800) +
+           (((g * mix + ((bg >> 5) & 0x3f) * inv) >> 3) & 0x07e0) +
+           ((b * mix + (bg & 0x1f) * inv) >> 8);
+}
+
+void sprite_blend_reference(uint16_t *dst, int32_t dst_stride, const uint32_t *src, int32_t src_stride,
+                            int32_t w, int32_t h) {
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d = ROW(uint16_t, dst, dst_stride, y);
+        const uint32_t *s = ROW(const uint32_t, src, src_stride, y);
+        for (int32_t x = 0; x < w; x++) {
+            uint32_t alpha = s[x] >> 24;
+            if (alpha == 0) continue;
+            d[x] = alpha == 255 ? argb_to_rgb565(s[x]) : mix_rgb565(s[x], d[x]);
+        }
+    }
+}
+
+static void opaque_run(uint16_t *dst, const uint32_t *src, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        dst[i] = argb_to_rgb565(src[i]);
+    }
+}
+
+static void mix_run(uint16_t *dst, const uint32_t *src, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        dst[i] = mix_rgb565(src[i], dst[i]);
+    }
+}
+
+static inline void blend_masked_row(uint16_t *d, const uint32_t *s, int32_t w) {
+    int32_t x = 0;
+    while (x < w) {
+        // Alpha is the top byte, so a transparent pixel is a word below
+        // 1 << 24 and an opaque one a word from 0xff000000. Four words are
+        // tested at once first: their OR stays below 1 << 24 only if all
+        // four are transparent, their AND reaches 0xff000000 only if all
+        // four are opaque.
+        while (x + 4 <= w && (s[x] | s[x + 1] | s[x + 2] | s[x + 3]) < (1u << 24)) x += 4;
+        while (x < w && s[x] < (1u << 24)) x++;
+
+        int32_t start = x;
+        while (x + 4 <= w && (s[x] & s[x + 1] & s[x + 2] & s[x + 3]) >= 0xff000000u) x += 4;
+        while (x < w && s[x] >= 0xff000000u) x++;
+        if (x > start) opaque_run(d + start, s + start, x - start);
+
+        start = x;
+        while (x < w && s[x] >= (1u << 24) && s[x] < 0xff000000u) x++;
+        if (x > start) mix_run(d + start, s + start, x - start);
+    }
+}
+
+void sprite_blend_masked(uint16_t *dst, int32_t dst_stride, const uint32_t *src, int32_t src_stride,
+                         int32_t w, int32_t h) {
+    for (int32_t y = 0; y < h; y++) {
+        blend_masked_row(ROW(uint16_t, dst, dst_stride, y), ROW(const uint32_t, src, src_stride, y), w);
+    }
+}
+
+static bool hook_enabled = true;
+
+void sprite_blend_hook_set_enabled(bool enabled) {
+    hook_enabled = enabled;
+}
+
+lv_result_t sprite_blend_argb8888_to_rgb565(void *dst, int32_t w, int32_t h, int32_t dst_stride, const void *src,
+                                            int32_t src_stride) {
+    if (!hook_enabled) return LV_RESULT_INVALID;
+    sprite_blend_masked(dst, dst_stride, src, src_stride, w, h);
+    return LV_RESULT_OK;
+}
@@ -0,0 +1,38 @@
+#ifndef SPRITE_BLEND_H
+#define SPRITE_BLEND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// ARGB8888 sprite pixels over an RGB565 draw buffer. The dinosaur frames
+// are pixel art whose alpha is almost always 0 or 255, while LVGL's
+// software blender runs its generic per-pixel mix for every pixel. With
+// CONFIG_TAMA_SPRITE_BLEND the masked kernel below replaces that loop
+// inside LVGL (sprite_blend_lvgl.h).
+//
+// Source pixels are 32-bit words, 0xAARRGGBB. Strides are in bytes, w and
+// h in pixels. All kernels give the same result as LVGL's mix: alpha 0
+// leaves the destination alone, alpha 255 stores the colour truncated to
+// RGB565, anything else (254 and 253 included) is mixed.
+
+typedef void (*sprite_blend_fn_t)(uint16_t *dst, int32_t dst_stride, const uint32_t *src, int32_t src_stride,
+                                  int32_t w, int32_t h);
+
+// Every pixel through LVGL's lv_color_24_16_mix(), as the software
+// renderer does
+void sprite_blend_reference(uint16_t *dst, int32_t dst_stride, const uint32_t *src, int32_t src_stride,
+                            int32_t w, int32_t h);
+
+// Skips transparent runs and finds opaque runs four pixel words at a
+// time, stores opaque runs without mixing; only pixels with partial alpha
+// are mixed
+void sprite_blend_masked(uint16_t *dst, int32_t dst_stride, const uint32_t *src, int32_t src_stride,
+                         int32_t w, int32_t h);
+
+// With CONFIG_TAMA_SPRITE_BLEND, whether the hook takes LVGL's ARGB8888
+// blends (the default) or hands them back to LVGL's own loop, so the
+// benchmark can time both in one build
+void sprite_blend_hook_set_enabled(bool enabled);
+
+#endif // SPRITE_BLEND_H
@@ -0,0 +1,19 @@
+#ifndef SPRITE_BLEND_LVGL_H
+#define SPRITE_BLEND_LVGL_H
+
+// Included by LVGL's software blenders as LV_DRAW_SW_ASM_CUSTOM_INCLUDE
+// (see main/CMakeLists.txt), after LVGL's own headers. LVGL calls the hook
+// for ARGB8888 images blended with full opacity, no mask and the normal
+// blend mode, and falls back to its own loop when it returns
+// LV_RESULT_INVALID.
+
+#include <stdint.h>
+
+lv_result_t sprite_blend_argb8888_to_rgb565(void *dst, int32_t w, int32_t h, int32_t dst_stride, const void *src,
+                                            int32_t src_stride);
+
+#define LV_DRAW_SW_ARGB8888_BLEND_NORMAL_TO_RGB565(dsc)                                                    \
+    sprite_blend_argb8888_to_rgb565((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                                    (dsc)->src_buf, (dsc)->src_stride)
+
+#endif // SPRITE_BLEND_LVGL_H
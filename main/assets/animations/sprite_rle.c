@@ -0,0 +1,122 @@
+#include "assets/animations/sprite_rle.h"
+#include <string.h>
+#if defined(__has_include) && __has_include("lvgl_private.h")
+#include "lvgl_private.h"  // LVGL >= 9.2 keeps the decoder descriptor private
+#endif
+
+// Rows handed to LVGL per get_area call
+#define SPRITE_RLE_STRIP_ROWS 16
+
+static sprite_rle_header_t sprite_rle_read_header(const uint8_t *data) {
+    sprite_rle_header_t header;
+    memcpy(&header, data, sizeof(header));
+    return header;
+}
+
+bool sprite_rle_is_valid(const lv_image_dsc_t *image) {
+    if (image->header.cf != LV_COLOR_FORMAT_RAW_ALPHA || image->data_size < sizeof(sprite_rle_header_t)) {
+        return false;
+    }
+    sprite_rle_header_t header = sprite_rle_read_header(image->data);
+    return header.magic == SPRITE_RLE_MAGIC && header.width == image->header.w && header.height == image->header.h;
+}
+
+void sprite_rle_decode_row(const uint8_t *data, uint16_t row, lv_color32_t *out) {
+    sprite_rle_header_t header = sprite_rle_read_header(data);
+    const uint8_t *palette_data = data + sizeof(header);
+    const uint8_t *offsets = palette_data + header.palette_size * sizeof(lv_color32_t);
+    const uint8_t *rows = offsets + header.height * sizeof(uint32_t);
+
+    uint32_t offset;
+    memcpy(&offset, offsets + row * sizeof(uint32_t), sizeof(offset));
+    const uint8_t *src = rows + offset;
+    const lv_color32_t *palette = (const lv_color32_t *)palette_data;
+
+    uint16_t x = 0;
+    while (x < header.width) {
+        uint8_t packet = *src++;
+        uint16_t count = (packet & 0x7f) + 1;
+        if (packet & 0x80) {
+            for (uint16_t i = 0; i < count; i++) {
+                out[x++] = palette[*src++];
+            }
+        } else if (*src == 0) {
+            // Transparent run: nothing to look up
+            memset(&out[x], 0, count * sizeof(lv_color32_t));
+            x += count;
+            src++;
+        } else {
+            lv_color32_t color = palette[*src++];
+            for (uint16_t i = 0; i < count; i++) {
+                out[x++] = color;
+            }
+        }
+    }
+}
+
+static lv_result_t sprite_rle_info(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header) {
+    LV_UNUSED(decoder);
+    if (dsc->src_type != LV_IMAGE_SRC_VARIABLE) return LV_RESULT_INVALID;
+
+    const lv_image_dsc_t *image = dsc->src;
+    if (!sprite_rle_is_valid(image)) return LV_RESULT_INVALID;
+
+    header->magic = LV_IMAGE_HEADER_MAGIC;
+    header->cf = LV_COLOR_FORMAT_ARGB8888;
+    header->w = image->header.w;
+    header->h = image->header.h;
+    header->stride = image->header.w * sizeof(lv_color32_t);
+    return LV_RESULT_OK;
+}
+
+static lv_result_t sprite_rle_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    const lv_image_dsc_t *image = dsc->src;
+
+    // Leave dsc->decoded NULL so LVGL pulls strips through get_area
+    lv_draw_buf_t *strip = lv_draw_buf_create(image->header.w, SPRITE_RLE_STRIP_ROWS, LV_COLOR_FORMAT_ARGB8888, 0);
+    if (!strip) return LV_RESULT_INVALID;
+    dsc->user_data = strip;
+    return LV_RESULT_OK;
+}
+
+static lv_result_t sprite_rle_get_area(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc,
+                                       const lv_area_t *full_area, lv_area_t *decoded_area) {
+    LV_UNUSED(decoder);
+    const lv_image_dsc_t *image = dsc->src;
+    lv_draw_buf_t *strip = dsc->user_data;
+
+    if (decoded_area->y1 == LV_COORD_MIN) {
+        decoded_area->y1 = full_area->y1;
+    } else {
+        decoded_area->y1 = decoded_area->y2 + 1;
+    }
+    if (decoded_area->y1 > full_area->y2) return LV_RESULT_INVALID;
+
+    // Whole rows are decoded; LVGL clips the strip to the area it needs
+    decoded_area->x1 = 0;
+    decoded_area->x2 = image->header.w - 1;
+    decoded_area->y2 = LV_MIN(decoded_area->y1 + SPRITE_RLE_STRIP_ROWS - 1, full_area->y2);
+
+    for (int32_t y = decoded_area->y1; y <= decoded_area->y2; y++) {
+        lv_color32_t *out = (lv_color32_t *)(strip->data + (y - decoded_area->y1) * strip->header.stride);
+        sprite_rle_decode_row(image->data, (uint16_t)y, out);
+    }
+    dsc->decoded = strip;
+    return LV_RESULT_OK;
+}
+
+static void sprite_rle_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    lv_draw_buf_destroy(dsc->user_data);
+    dsc->user_data = NULL;
+    dsc->decoded = NULL;
+}
+
+void sprite_rle_decoder_init(void) {
+    lv_image_decoder_t *decoder = lv_image_decoder_create();
+    lv_image_decoder_set_info_cb(decoder, sprite_rle_info);
+    lv_image_decoder_set_open_cb(decoder, sprite_rle_open);
+    lv_image_decoder_set_get_area_cb(decoder, sprite_rle_get_area);
+    lv_image_decoder_set_close_cb(decoder, sprite_rle_close);
+}
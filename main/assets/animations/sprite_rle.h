@@ -0,0 +1,44 @@
+#ifndef SPRITE_RLE_H
+#define SPRITE_RLE_H
+
+#include "lvgl.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Run-length encoded sprites, written by tools/sprite_convert.py --format rle.
+// The image descriptor uses LV_COLOR_FORMAT_RAW_ALPHA and its data is:
+//
+//   sprite_rle_header_t
+//   lv_color32_t palette[palette_size]
+//   uint32_t row_offsets[height]     // from the start of the row data
+//   uint8_t rows[]
+//
+// A row is a sequence of packets: 0x00-0x7f is a run of (n + 1) pixels of
+// the following palette index, 0x80-0xff is (n & 0x7f) + 1 literal indices.
+// Palette index 0 is fully transparent.
+//
+// With the default converter options every animation is delta-encoded and
+// no frame is stored as RLE; the decoder is used with
+// SPRITE_CONVERT_ARGS="--delta;off;--format;rle" and by the sprite
+// benchmark, which embeds converter-made RLE frames of its own.
+
+#define SPRITE_RLE_MAGIC 0x454C5254  // "TRLE"
+
+typedef struct {
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    uint16_t palette_size;
+    uint16_t reserved;
+} sprite_rle_header_t;
+
+bool sprite_rle_is_valid(const lv_image_dsc_t *image);
+
+// Decode one row into `out` (width pixels).
+void sprite_rle_decode_row(const uint8_t *data, uint16_t row, lv_color32_t *out);
+
+// Register the streaming LVGL decoder. It hands LVGL a few rows at a time
+// through get_area, so a frame is never decoded as a whole.
+void sprite_rle_decoder_init(void);
+
+#endif // SPRITE_RLE_H